@@ -0,0 +1,107 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Keeps the compiler from optimizing away a result that the benchmark never uses.
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+class Timer
+{
+    public:
+        Timer() : m_start(std::chrono::steady_clock::now()) {}
+        double seconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+    private:
+        std::chrono::steady_clock::time_point m_start;
+};
+
+// Counts hardware cache misses for the calling thread. On systems without perf events
+// (non-Linux, containers, perf_event_paranoid too high) available() returns false and
+// the benchmarks report timings only.
+class CacheMissCounter
+{
+    public:
+#if defined(__linux__)
+        CacheMissCounter()
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+        ~CacheMissCounter() { if (m_fd >= 0) close(m_fd); }
+        bool available() const noexcept { return m_fd >= 0; }
+        void start()
+        {
+            if (m_fd < 0) return;
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        uint64_t stop()
+        {
+            uint64_t count = 0;
+            if (m_fd < 0) return count;
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+            return count;
+        }
+#else
+        bool available() const noexcept { return false; }
+        void start() {}
+        uint64_t stop() { return 0; }
+#endif
+        CacheMissCounter(const CacheMissCounter&) = delete;
+        CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+    private:
+#if defined(__linux__)
+        int m_fd = -1;
+#endif
+};
+
+inline void report(const std::string& name, size_t elements, double seconds)
+{
+    std::cout << name << ": " << seconds * 1e3 << " ms, "
+        << elements / seconds / 1e6 << " M elements/s\n";
+}
+
+inline void report(const std::string& name, size_t elements, double seconds,
+    const CacheMissCounter& counter, uint64_t misses)
+{
+    std::cout << name << ": " << seconds * 1e3 << " ms, "
+        << elements / seconds / 1e6 << " M elements/s";
+    if (counter.available())
+    {
+        std::cout << ", " << misses << " cache misses";
+    }
+    std::cout << '\n';
+}
+
+#endif      // BENCHUTIL_H
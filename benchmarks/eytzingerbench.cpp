@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "eytzinger.h"
+#include "benchutil.h"
+
+class Key : public Value<int64_t>
+{
+    public:
+        Key(int64_t key) : Value(key) {}
+};
+
+class Keys : public Values<Key>
+{
+    public:
+        using value_type = Key;
+};
+
+static void run(size_t count, size_t lookups)
+{
+    Keys keys;
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys.push_back(Key(static_cast<int64_t>(2 * i)));
+    }
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<int64_t> dist(0, static_cast<int64_t>(2 * count));
+    std::vector<int64_t> queries(lookups);
+    for (auto& query: queries)
+    {
+        query = dist(gen);
+    }
+
+    Timer buildTimer;
+    EytzingerIndex<Key> index(keys);
+    const double buildSeconds = buildTimer.seconds();
+    CacheMissCounter counter;
+    std::cout << count << " keys, " << lookups << " lookups, index built in "
+        << buildSeconds * 1e3 << " ms\n";
+
+    auto report_latency = [&](const std::string& name, double seconds, uint64_t misses, int64_t check) {
+        std::cout << "  " << name << ": " << seconds / lookups * 1e9 << " ns/lookup";
+        if (counter.available())
+        {
+            std::cout << ", " << static_cast<double>(misses) / lookups << " cache misses/lookup";
+        }
+        std::cout << " (checksum " << check << ")\n";
+    };
+
+    {
+        int64_t check = 0;
+        counter.start();
+        Timer timer;
+        for (auto query: queries)
+        {
+            auto iter = std::lower_bound(keys.cbegin(), keys.cend(), query,
+                [](const Key& key, int64_t q) { return key.getValue() < q; });
+            check += iter - keys.cbegin();
+        }
+        auto seconds = timer.seconds();
+        report_latency("std::lower_bound", seconds, counter.stop(), check);
+    }
+    {
+        int64_t check = 0;
+        counter.start();
+        Timer timer;
+        for (auto query: queries)
+        {
+            check += index.lower_bound(query) - keys.cbegin();
+        }
+        auto seconds = timer.seconds();
+        report_latency("EytzingerIndex::lower_bound", seconds, counter.stop(), check);
+    }
+    {
+        std::vector<Keys::const_iterator> results;
+        results.reserve(lookups);
+        counter.start();
+        Timer timer;
+        index.lower_bound(queries.begin(), queries.end(), std::back_inserter(results));
+        auto seconds = timer.seconds();
+        auto misses = counter.stop();
+        int64_t check = 0;
+        for (auto iter: results)
+        {
+            check += iter - keys.cbegin();
+        }
+        report_latency("EytzingerIndex::lower_bound, batched", seconds, misses, check);
+    }
+    {
+        int64_t check = 0;
+        counter.start();
+        Timer timer;
+        for (auto query: queries)
+        {
+            auto range = index.equal_range(query);
+            check += range.second - range.first;
+        }
+        auto seconds = timer.seconds();
+        report_latency("EytzingerIndex::equal_range", seconds, counter.stop(), check);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t lookups = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    for (size_t count: { size_t(1000), size_t(100000), size_t(1000000), size_t(10000000) })
+    {
+        run(count, lookups);
+    }
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "values.h"
+#include "benchutil.h"
+
+class Str : public Value<std::string>
+{
+    public:
+        Str(const std::string& str) : Value(str) {}
+};
+
+class Strs : public Values<Str>
+{
+    public:
+        using value_type = Str;
+};
+
+// Builds a container whose string payloads are scattered across the heap, as they are
+// after a long period of unrelated allocations, so that a scan cannot rely on the
+// hardware prefetcher following the allocation order.
+static Strs make_scattered(size_t count, size_t length)
+{
+    Strs values;
+    for (size_t pos = 0; pos < count; ++pos)
+    {
+        values.push_back(Str(std::string()));
+    }
+
+    // Assigning in shuffled order allocates the payloads in shuffled order.
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    for (auto pos: order)
+    {
+        values[pos] = Str(std::string(length, static_cast<char>('a' + pos % 26)));
+    }
+    return values;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    const size_t length = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+    const Strs values = make_scattered(count, length);
+    CacheMissCounter counter;
+
+    std::cout << count << " strings of " << length << " characters\n";
+    if (!counter.available())
+    {
+        std::cout << "(hardware cache miss counters are not available)\n";
+    }
+
+    auto middle_char = [](const Str& s) {
+        return static_cast<unsigned char>(s.getValue()[s.getValue().size() / 2]);
+    };
+
+    {
+        size_t sum = 0;
+        counter.start();
+        Timer timer;
+        for (auto iter = values.cbegin(); iter != values.cend(); ++iter)
+        {
+            sum += middle_char(*iter);
+        }
+        auto seconds = timer.seconds();
+        auto misses = counter.stop();
+        do_not_optimize(sum);
+        report("const_iterator scan", count, seconds, counter, misses);
+    }
+
+    for (size_t distance: { size_t(0), size_t(2), size_t(4), size_t(8), size_t(16), size_t(32) })
+    {
+        size_t sum = 0;
+        counter.start();
+        Timer timer;
+        values.for_each_prefetched([&](const Str& s) { sum += middle_char(s); }, distance,
+            [](const Str& s) { return s.getValue().data() + s.getValue().size() / 2; });
+        auto seconds = timer.seconds();
+        auto misses = counter.stop();
+        do_not_optimize(sum);
+        report("for_each_prefetched, distance " + std::to_string(distance), count, seconds,
+            counter, misses);
+    }
+}
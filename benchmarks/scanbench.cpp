@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include "values.h"
+#include "benchutil.h"
+
+// Value<T> itself selects the structure-of-arrays specialization, so a derived class
+// gives the current layout of one Value object, vptr included, per element.
+template<typename T>
+class Num : public Value<T>
+{
+    public:
+        Num(T num) : Value<T>(num) {}
+};
+
+template<typename T>
+class Nums : public Values<Num<T>>
+{
+    public:
+        using value_type = Num<T>;
+};
+
+static const char* level_name(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::avx2: return "avx2";
+        case SimdLevel::sse41: return "sse4.1";
+        default: return "scalar";
+    }
+}
+
+template<typename Function>
+static void measure(const std::string& name, size_t count, int repeats, Function f)
+{
+    Timer timer;
+    for (int repeat = 0; repeat < repeats; ++repeat)
+    {
+        do_not_optimize(f());
+    }
+    report(name, count * repeats, timer.seconds());
+}
+
+template<typename T>
+static void run(const std::string& typeName, size_t count, int repeats)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+    Nums<T> objects;
+    Values<Value<T>> payloads;
+    for (size_t i = 0; i < count; ++i)
+    {
+        T value = static_cast<T>(dist(gen));
+        objects.push_back(Num<T>(value));
+        payloads.push_back(Value<T>(value));
+    }
+    // Not in the data, so find scans everything.
+    const T missing = static_cast<T>(5000);
+
+    std::cout << typeName << ", " << count << " elements\n";
+    auto less = [](const Num<T>& a, const Num<T>& b) { return a.getValue() < b.getValue(); };
+    measure("  Values<Num>: find_if", count, repeats, [&] {
+        return std::find_if(objects.cbegin(), objects.cend(),
+            [&](const Num<T>& v) { return v.getValue() == missing; }) - objects.cbegin();
+    });
+    measure("  Values<Num>: count_if", count, repeats, [&] {
+        return std::count_if(objects.cbegin(), objects.cend(),
+            [](const Num<T>& v) { return v.getValue() == T(0); });
+    });
+    measure("  Values<Num>: min_element", count, repeats, [&] {
+        return std::min_element(objects.cbegin(), objects.cend(), less)->getValue();
+    });
+    measure("  Values<Num>: sum", count, repeats, [&] {
+        scan_sum_t<T> total = 0;
+        for (auto& v: objects)
+        {
+            total += v.getValue();
+        }
+        return total;
+    });
+
+    const T* data = payloads.data();
+    for (auto level: { SimdLevel::scalar, SimdLevel::sse41, SimdLevel::avx2 })
+    {
+        if (level > detected_simd_level()) break;
+        const std::string prefix = std::string("  Values<Value> ") + level_name(level) + ": ";
+        measure(prefix + "find", count, repeats,
+            [&] { return ScanKernels<T>::find(data, count, missing, level); });
+        measure(prefix + "count", count, repeats,
+            [&] { return ScanKernels<T>::count(data, count, T(0), level); });
+        measure(prefix + "min_element", count, repeats,
+            [&] { return ScanKernels<T>::min_element(data, count, level); });
+        measure(prefix + "sum", count, repeats,
+            [&] { return ScanKernels<T>::sum(data, count, level); });
+    }
+    measure("  Values<Value>: filter", count, repeats,
+        [&] { return payloads.filter([](T value) { return value > T(0); }).size(); });
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 20;
+    std::cout << "detected SIMD level: " << level_name(detected_simd_level()) << '\n';
+    run<int32_t>("int32_t", count, repeats);
+    run<float>("float", count, repeats);
+    run<double>("double", count, repeats);
+}
@@ -0,0 +1,137 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "valuesio.h"
+#include "benchutil.h"
+
+class Str : public Value<std::string>
+{
+    public:
+        Str(const std::string& str) : Value(str) {}
+};
+
+class Strs : public Values<Str>
+{
+    public:
+        using value_type = Str;
+};
+
+class Num : public Value<int64_t>
+{
+    public:
+        Num(int64_t num) : Value(num) {}
+};
+
+class Nums : public Values<Num>
+{
+    public:
+        using value_type = Num;
+};
+
+static const size_t stream_buffer_bytes = size_t(1) << 20;
+
+static double file_megabytes(const std::string& path)
+{
+    std::ifstream is(path, std::ios::binary | std::ios::ate);
+    return static_cast<double>(is.tellg()) / 1e6;
+}
+
+template<typename Container>
+static void round_trip(const std::string& name, const Container& values, const std::string& path,
+    bool checksums)
+{
+    std::vector<char> buffer(stream_buffer_bytes);
+    {
+        std::ofstream os;
+        os.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        os.open(path, std::ios::binary | std::ios::trunc);
+        Timer timer;
+        write_values(os, values, checksums);
+        auto seconds = timer.seconds();
+        os.close();
+        std::cout << "  " << name << (checksums ? ", checksums" : "") << ": write "
+            << file_megabytes(path) / seconds << " MB/s, " << values.size() / seconds / 1e6 << " M elements/s";
+    }
+    {
+        std::ifstream is;
+        is.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        is.open(path, std::ios::binary);
+        Container values2;
+        Timer timer;
+        read_values(is, values2);
+        auto seconds = timer.seconds();
+        std::cout << "; read " << file_megabytes(path) / seconds << " MB/s, "
+            << values2.size() / seconds / 1e6 << " M elements/s\n";
+    }
+}
+
+// The way a Container was snapshotted before: one formatted line per element.
+static void text_round_trip(const Strs& values, const std::string& path)
+{
+    {
+        std::ofstream os(path, std::ios::trunc);
+        Timer timer;
+        for (auto iter = values.cbegin(); iter != values.cend(); ++iter)
+        {
+            os << iter->getValue() << '\n';
+        }
+        os.flush();
+        auto seconds = timer.seconds();
+        std::cout << "  strings, formatted text: write " << values.size() / seconds / 1e6 << " M elements/s";
+    }
+    {
+        std::ifstream is(path);
+        Strs values2;
+        Timer timer;
+        std::string line;
+        while (std::getline(is, line))
+        {
+            values2.push_back(Str(line));
+        }
+        auto seconds = timer.seconds();
+        std::cout << "; read " << values2.size() / seconds / 1e6 << " M elements/s\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    const std::string path = argc > 2 ? argv[2] : "valuesiobench.bin";
+    std::cout << count << " elements, file " << path << '\n';
+
+    {
+        Values<Value<int32_t>> ints;
+        ints.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            ints.push_back(Value<int32_t>(static_cast<int32_t>(i * 2654435761u)));
+        }
+        round_trip("Values<Value<int32_t>>", ints, path, false);
+        round_trip("Values<Value<int32_t>>", ints, path, true);
+    }
+    {
+        Nums nums;
+        nums.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            nums.push_back(Num(static_cast<int64_t>(i * 2654435761u)));
+        }
+        round_trip("Values<Num> (int64_t)", nums, path, false);
+        round_trip("Values<Num> (int64_t)", nums, path, true);
+    }
+    {
+        Strs strs;
+        strs.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            strs.push_back(Str("String " + std::to_string(i)));
+        }
+        round_trip("strings", strs, path, false);
+        round_trip("strings", strs, path, true);
+        text_round_trip(strs, path);
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,203 @@
+#ifndef EYTZINGER_H
+#define EYTZINGER_H
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "values.h"
+
+// Default key extractor for EytzingerIndex: the payload of a Value.
+struct ValueKey
+{
+    template<typename T>
+    auto operator()(const T& value) const -> decltype(value.getValue()) { return value.getValue(); }
+};
+
+// A read-optimized search index over a sorted Values container.
+//
+// The keys are copied out of the container into Eytzinger (breadth-first binary tree) order,
+// so the first levels of every search share the same few cache lines and the nodes visited
+// further down can be prefetched several levels ahead. Lookups return const_iterators into
+// the original container.
+//
+// The container must be sorted by Compare on the extracted keys, and must outlive the index.
+// Any change to the container invalidates the index; build a new one after modifying it.
+template<typename T, typename KeyOf = ValueKey,
+    typename Compare = std::less<std::decay_t<std::invoke_result_t<KeyOf, const T&>>>>
+class EytzingerIndex
+{
+    public:
+        using key_type = std::decay_t<std::invoke_result_t<KeyOf, const T&>>;
+        using const_iterator = typename Values<T>::const_iterator;
+
+        explicit EytzingerIndex(const Values<T>& values, KeyOf keyOf = KeyOf(), Compare comp = Compare())
+            : m_values(&values), m_comp(comp)
+        {
+            const size_t count = values.size();
+            // Slot 0 is unused so that the children of slot k are 2k and 2k + 1.
+            m_keys.resize(count + 1);
+            m_positions.resize(count + 1);
+            build(values, keyOf, 0, 1);
+        }
+
+        size_t size() const noexcept { return m_keys.size() - 1; }
+
+        // First element whose key is not less than key, or cend() if there is none.
+        const_iterator lower_bound(const key_type& key) const
+        {
+            return to_iterator(search(key, [this](const key_type& node, const key_type& k)
+                { return m_comp(node, k); }));
+        }
+
+        // First element whose key is greater than key, or cend() if there is none.
+        const_iterator upper_bound(const key_type& key) const
+        {
+            return to_iterator(search(key, [this](const key_type& node, const key_type& k)
+                { return !m_comp(k, node); }));
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+        {
+            return { lower_bound(key), upper_bound(key) };
+        }
+
+        // Batched lower_bound: writes lower_bound(key) to out for each key in [first, last).
+        // The searches are interleaved in groups so that the cache misses of several lookups
+        // overlap instead of being paid one after another.
+        template<typename InputIt, typename OutputIt>
+        OutputIt lower_bound(InputIt first, InputIt last, OutputIt out) const
+        {
+            const size_t count = size();
+            // Number of tree levels that are complete, and so exist for every search path.
+            size_t fullLevels = 0;
+            while ((size_t(2) << fullLevels) - 1 <= count)
+            {
+                ++fullLevels;
+            }
+
+            // The keys are copied, so any input iterator works, including ones that return
+            // by value or whose value type only converts to key_type.
+            key_type keys[batch_size];
+            size_t slots[batch_size];
+            while (first != last)
+            {
+                size_t lanes = 0;
+                for (; lanes < batch_size && first != last; ++lanes, ++first)
+                {
+                    keys[lanes] = static_cast<key_type>(*first);
+                    slots[lanes] = 1;
+                }
+                for (size_t level = 0; level < fullLevels; ++level)
+                {
+                    for (size_t lane = 0; lane < lanes; ++lane)
+                    {
+                        size_t& k = slots[lane];
+                        prefetch_slot(k);
+                        k = 2 * k + (m_comp(m_keys[k], keys[lane]) ? 1 : 0);
+                    }
+                }
+                for (size_t lane = 0; lane < lanes; ++lane)
+                {
+                    size_t k = slots[lane];
+                    if (k <= count)
+                    {
+                        k = 2 * k + (m_comp(m_keys[k], keys[lane]) ? 1 : 0);
+                    }
+                    *out = to_iterator(last_left_turn(k));
+                    ++out;
+                }
+            }
+            return out;
+        }
+
+    private:
+        static constexpr size_t batch_size = 16;
+        static constexpr size_t cache_line_bytes = 64;
+
+        // The descendants of slot k that are L levels down are the 2^L adjacent slots starting
+        // at slot k * 2^L. Searches prefetch them L levels ahead, with one prefetch per cache line
+        // they span, so L is the largest depth up to 4 whose descendants fit in two lines:
+        // 4 levels for 8-byte keys, 2 levels for 32-byte std::strings.
+        static constexpr size_t choose_prefetch_levels()
+        {
+            size_t levels = 4;
+            while (levels > 1 && (size_t(1) << levels) * sizeof(key_type) > 2 * cache_line_bytes)
+            {
+                --levels;
+            }
+            return levels;
+        }
+        static constexpr size_t prefetch_levels = choose_prefetch_levels();
+
+        size_t build(const Values<T>& values, KeyOf& keyOf, size_t pos, size_t k)
+        {
+            if (k < m_keys.size())
+            {
+                pos = build(values, keyOf, pos, 2 * k);
+                m_keys[k] = keyOf(values[pos]);
+                m_positions[k] = pos++;
+                pos = build(values, keyOf, pos, 2 * k + 1);
+            }
+            return pos;
+        }
+
+        void prefetch_slot(size_t k) const noexcept
+        {
+            const size_t first = k << prefetch_levels;
+            if (first >= m_keys.size()) return;
+            const size_t last = std::min(first + (size_t(1) << prefetch_levels), m_keys.size()) - 1;
+            // m_keys starts on a cache line boundary, so byte offsets rounded down to a multiple
+            // of the line size are line starts.
+            const char* base = reinterpret_cast<const char*>(m_keys.data());
+            const size_t lastByte = (last + 1) * sizeof(key_type) - 1;
+            for (size_t offset = first * sizeof(key_type) & ~(cache_line_bytes - 1); offset <= lastByte;
+                offset += cache_line_bytes)
+            {
+                prefetch_address(base + offset);
+            }
+        }
+
+        // Walks down the tree, going right while goRight(node, key) holds, and returns the
+        // slot of the last node where the walk went left, or 0 if it never did.
+        template<typename GoRight>
+        size_t search(const key_type& key, GoRight goRight) const
+        {
+            const size_t count = size();
+            size_t k = 1;
+            while (k <= count)
+            {
+                prefetch_slot(k);
+                k = 2 * k + (goRight(m_keys[k], key) ? 1 : 0);
+            }
+            return last_left_turn(k);
+        }
+
+        // The bits of k below the leading 1 record the turns taken (1 = right). Dropping the
+        // trailing right turns and the last left turn gives the slot where the walk last went left.
+        static size_t last_left_turn(size_t k) noexcept
+        {
+            while (k & 1)
+            {
+                k >>= 1;
+            }
+            return k >> 1;
+        }
+
+        const_iterator to_iterator(size_t k) const
+        {
+            if (k == 0)
+            {
+                return m_values->cend();
+            }
+            return m_values->cbegin() + static_cast<std::ptrdiff_t>(m_positions[k]);
+        }
+
+        const Values<T>* m_values;
+        Compare m_comp;
+        std::vector<key_type, AlignedAllocator<key_type, cache_line_bytes>> m_keys;
+        std::vector<size_t> m_positions;
+};
+
+#endif      // EYTZINGER_H
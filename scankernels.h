@@ -0,0 +1,460 @@
+#ifndef SCANKERNELS_H
+#define SCANKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// The SIMD kernels are compiled for their instruction set with target attributes, so the rest
+// of the program does not need -mavx2, and are selected at runtime from the CPU features.
+// Compilers without target attributes (MSVC) and other architectures use the scalar kernels.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SCANKERNELS_X86
+#define SCANKERNELS_TARGET_SSE41 __attribute__((target("sse4.1,popcnt")))
+#define SCANKERNELS_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#include <immintrin.h>
+#endif
+
+enum class SimdLevel
+{
+    scalar,
+    sse41,
+    avx2
+};
+
+// The best instruction set supported by this CPU, determined on the first call.
+inline SimdLevel detected_simd_level() noexcept
+{
+#if defined(SCANKERNELS_X86)
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        // The kernels count matches with popcnt, which every AVX2 CPU has but some
+        // SSE4.1 CPUs lack.
+        if (!__builtin_cpu_supports("popcnt")) return SimdLevel::scalar;
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::avx2;
+        if (__builtin_cpu_supports("sse4.1")) return SimdLevel::sse41;
+        return SimdLevel::scalar;
+    }();
+    return level;
+#else
+    return SimdLevel::scalar;
+#endif
+}
+
+// Integer sums are widened to 64 bits so that they do not overflow for large containers.
+template<typename T>
+using scan_sum_t = std::conditional_t<std::is_floating_point_v<T>, T,
+    std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+// Reference implementations, used for the types and CPUs that have no SIMD kernels and for
+// the tails of the arrays that do not fill a whole register.
+template<typename T>
+struct ScalarKernels
+{
+    static size_t find(const T* data, size_t count, T value) noexcept
+    {
+        size_t pos = 0;
+        while (pos < count && !(data[pos] == value))
+        {
+            ++pos;
+        }
+        return pos;
+    }
+
+    static size_t count(const T* data, size_t count, T value) noexcept
+    {
+        size_t matches = 0;
+        for (size_t pos = 0; pos < count; ++pos)
+        {
+            matches += data[pos] == value ? 1 : 0;
+        }
+        return matches;
+    }
+
+    template<bool Max>
+    static size_t extreme_element(const T* data, size_t count) noexcept
+    {
+        if (count == 0) return 0;
+        size_t best = 0;
+        for (size_t pos = 1; pos < count; ++pos)
+        {
+            if (Max ? data[best] < data[pos] : data[pos] < data[best])
+            {
+                best = pos;
+            }
+        }
+        return best;
+    }
+
+    static scan_sum_t<T> sum(const T* data, size_t count) noexcept
+    {
+        scan_sum_t<T> total = 0;
+        for (size_t pos = 0; pos < count; ++pos)
+        {
+            total += data[pos];
+        }
+        return total;
+    }
+
+    // Copies the elements that satisfy pred to out and returns how many were copied.
+    // Every element is written and the output position advanced by the predicate result,
+    // so the loop has no data-dependent branches to mispredict.
+    template<typename Predicate>
+    static size_t filter(const T* data, size_t count, T* out, Predicate pred)
+    {
+        size_t kept = 0;
+        for (size_t pos = 0; pos < count; ++pos)
+        {
+            out[kept] = data[pos];
+            kept += pred(data[pos]) ? 1 : 0;
+        }
+        return kept;
+    }
+};
+
+#if defined(SCANKERNELS_X86)
+
+template<typename T>
+struct is_simd_scannable
+    : std::integral_constant<bool, std::is_same_v<T, int32_t> || std::is_same_v<T, float> ||
+        std::is_same_v<T, double>> {};
+
+// SSE4.1 kernels for int32_t, float and double. The overloaded helpers let one template
+// per operation serve all three types.
+struct Sse41Kernels
+{
+    template<typename T>
+    static SCANKERNELS_TARGET_SSE41 size_t find(const T* data, size_t count, T value) noexcept
+    {
+        constexpr size_t width = 16 / sizeof(T);
+        const auto needle = set1(value);
+        size_t pos = 0;
+        for (; pos + width <= count; pos += width)
+        {
+            if (int mask = eq_mask(load(data + pos), needle))
+            {
+                return pos + __builtin_ctz(static_cast<unsigned>(mask));
+            }
+        }
+        return pos + ScalarKernels<T>::find(data + pos, count - pos, value);
+    }
+
+    template<typename T>
+    static SCANKERNELS_TARGET_SSE41 size_t count(const T* data, size_t count, T value) noexcept
+    {
+        constexpr size_t width = 16 / sizeof(T);
+        const auto needle = set1(value);
+        size_t matches = 0;
+        size_t pos = 0;
+        for (; pos + width <= count; pos += width)
+        {
+            matches += __builtin_popcount(static_cast<unsigned>(eq_mask(load(data + pos), needle)));
+        }
+        return matches + ScalarKernels<T>::count(data + pos, count - pos, value);
+    }
+
+    // Returns the extreme value; the caller locates it with find.
+    template<bool Max, typename T>
+    static SCANKERNELS_TARGET_SSE41 T extreme(const T* data, size_t count) noexcept
+    {
+        constexpr size_t width = 16 / sizeof(T);
+        T best = data[0];
+        size_t pos = 0;
+        if (count >= width)
+        {
+            auto acc = load(data);
+            for (pos = width; pos + width <= count; pos += width)
+            {
+                acc = Max ? max(load(data + pos), acc) : min(load(data + pos), acc);
+            }
+            T lanes[width];
+            store(lanes, acc);
+            best = lanes[0];
+            for (size_t lane = 1; lane < width; ++lane)
+            {
+                best = (Max ? best < lanes[lane] : lanes[lane] < best) ? lanes[lane] : best;
+            }
+        }
+        for (; pos < count; ++pos)
+        {
+            best = (Max ? best < data[pos] : data[pos] < best) ? data[pos] : best;
+        }
+        return best;
+    }
+
+    static SCANKERNELS_TARGET_SSE41 int64_t sum(const int32_t* data, size_t count) noexcept
+    {
+        __m128i acc = _mm_setzero_si128();
+        size_t pos = 0;
+        for (; pos + 4 <= count; pos += 4)
+        {
+            const __m128i values = load(data + pos);
+            acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(values));
+            acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(values, values)));
+        }
+        int64_t lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        return lanes[0] + lanes[1] + ScalarKernels<int32_t>::sum(data + pos, count - pos);
+    }
+
+    template<typename T>
+    static SCANKERNELS_TARGET_SSE41 T sum(const T* data, size_t count) noexcept
+    {
+        constexpr size_t width = 16 / sizeof(T);
+        auto acc = set1(T(0));
+        size_t pos = 0;
+        for (; pos + width <= count; pos += width)
+        {
+            acc = add(acc, load(data + pos));
+        }
+        T lanes[width];
+        store(lanes, acc);
+        T total = 0;
+        for (auto lane: lanes)
+        {
+            total += lane;
+        }
+        return total + ScalarKernels<T>::sum(data + pos, count - pos);
+    }
+
+    private:
+        static SCANKERNELS_TARGET_SSE41 __m128i load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        static SCANKERNELS_TARGET_SSE41 __m128 load(const float* p) { return _mm_loadu_ps(p); }
+        static SCANKERNELS_TARGET_SSE41 __m128d load(const double* p) { return _mm_loadu_pd(p); }
+        static SCANKERNELS_TARGET_SSE41 void store(int32_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+        static SCANKERNELS_TARGET_SSE41 void store(float* p, __m128 v) { _mm_storeu_ps(p, v); }
+        static SCANKERNELS_TARGET_SSE41 void store(double* p, __m128d v) { _mm_storeu_pd(p, v); }
+        static SCANKERNELS_TARGET_SSE41 __m128i set1(int32_t v) { return _mm_set1_epi32(v); }
+        static SCANKERNELS_TARGET_SSE41 __m128 set1(float v) { return _mm_set1_ps(v); }
+        static SCANKERNELS_TARGET_SSE41 __m128d set1(double v) { return _mm_set1_pd(v); }
+        static SCANKERNELS_TARGET_SSE41 int eq_mask(__m128i a, __m128i b) { return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))); }
+        static SCANKERNELS_TARGET_SSE41 int eq_mask(__m128 a, __m128 b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+        static SCANKERNELS_TARGET_SSE41 int eq_mask(__m128d a, __m128d b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+        static SCANKERNELS_TARGET_SSE41 __m128i min(__m128i a, __m128i b) { return _mm_min_epi32(a, b); }
+        static SCANKERNELS_TARGET_SSE41 __m128 min(__m128 a, __m128 b) { return _mm_min_ps(a, b); }
+        static SCANKERNELS_TARGET_SSE41 __m128d min(__m128d a, __m128d b) { return _mm_min_pd(a, b); }
+        static SCANKERNELS_TARGET_SSE41 __m128i max(__m128i a, __m128i b) { return _mm_max_epi32(a, b); }
+        static SCANKERNELS_TARGET_SSE41 __m128 max(__m128 a, __m128 b) { return _mm_max_ps(a, b); }
+        static SCANKERNELS_TARGET_SSE41 __m128d max(__m128d a, __m128d b) { return _mm_max_pd(a, b); }
+        static SCANKERNELS_TARGET_SSE41 __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+        static SCANKERNELS_TARGET_SSE41 __m128d add(__m128d a, __m128d b) { return _mm_add_pd(a, b); }
+};
+
+// AVX2 counterparts of Sse41Kernels, working on 256-bit registers.
+struct Avx2Kernels
+{
+    template<typename T>
+    static SCANKERNELS_TARGET_AVX2 size_t find(const T* data, size_t count, T value) noexcept
+    {
+        constexpr size_t width = 32 / sizeof(T);
+        const auto needle = set1(value);
+        size_t pos = 0;
+        for (; pos + width <= count; pos += width)
+        {
+            if (int mask = eq_mask(load(data + pos), needle))
+            {
+                return pos + __builtin_ctz(static_cast<unsigned>(mask));
+            }
+        }
+        return pos + ScalarKernels<T>::find(data + pos, count - pos, value);
+    }
+
+    template<typename T>
+    static SCANKERNELS_TARGET_AVX2 size_t count(const T* data, size_t count, T value) noexcept
+    {
+        constexpr size_t width = 32 / sizeof(T);
+        const auto needle = set1(value);
+        size_t matches = 0;
+        size_t pos = 0;
+        for (; pos + width <= count; pos += width)
+        {
+            matches += __builtin_popcount(static_cast<unsigned>(eq_mask(load(data + pos), needle)));
+        }
+        return matches + ScalarKernels<T>::count(data + pos, count - pos, value);
+    }
+
+    template<bool Max, typename T>
+    static SCANKERNELS_TARGET_AVX2 T extreme(const T* data, size_t count) noexcept
+    {
+        constexpr size_t width = 32 / sizeof(T);
+        T best = data[0];
+        size_t pos = 0;
+        if (count >= width)
+        {
+            auto acc = load(data);
+            for (pos = width; pos + width <= count; pos += width)
+            {
+                acc = Max ? max(load(data + pos), acc) : min(load(data + pos), acc);
+            }
+            T lanes[width];
+            store(lanes, acc);
+            best = lanes[0];
+            for (size_t lane = 1; lane < width; ++lane)
+            {
+                best = (Max ? best < lanes[lane] : lanes[lane] < best) ? lanes[lane] : best;
+            }
+        }
+        for (; pos < count; ++pos)
+        {
+            best = (Max ? best < data[pos] : data[pos] < best) ? data[pos] : best;
+        }
+        return best;
+    }
+
+    static SCANKERNELS_TARGET_AVX2 int64_t sum(const int32_t* data, size_t count) noexcept
+    {
+        __m256i acc = _mm256_setzero_si256();
+        size_t pos = 0;
+        for (; pos + 8 <= count; pos += 8)
+        {
+            const __m256i values = load(data + pos);
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+        }
+        int64_t lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+            ScalarKernels<int32_t>::sum(data + pos, count - pos);
+    }
+
+    template<typename T>
+    static SCANKERNELS_TARGET_AVX2 T sum(const T* data, size_t count) noexcept
+    {
+        constexpr size_t width = 32 / sizeof(T);
+        auto acc = set1(T(0));
+        size_t pos = 0;
+        for (; pos + width <= count; pos += width)
+        {
+            acc = add(acc, load(data + pos));
+        }
+        T lanes[width];
+        store(lanes, acc);
+        T total = 0;
+        for (auto lane: lanes)
+        {
+            total += lane;
+        }
+        return total + ScalarKernels<T>::sum(data + pos, count - pos);
+    }
+
+    private:
+        static SCANKERNELS_TARGET_AVX2 __m256i load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static SCANKERNELS_TARGET_AVX2 __m256 load(const float* p) { return _mm256_loadu_ps(p); }
+        static SCANKERNELS_TARGET_AVX2 __m256d load(const double* p) { return _mm256_loadu_pd(p); }
+        static SCANKERNELS_TARGET_AVX2 void store(int32_t* p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+        static SCANKERNELS_TARGET_AVX2 void store(float* p, __m256 v) { _mm256_storeu_ps(p, v); }
+        static SCANKERNELS_TARGET_AVX2 void store(double* p, __m256d v) { _mm256_storeu_pd(p, v); }
+        static SCANKERNELS_TARGET_AVX2 __m256i set1(int32_t v) { return _mm256_set1_epi32(v); }
+        static SCANKERNELS_TARGET_AVX2 __m256 set1(float v) { return _mm256_set1_ps(v); }
+        static SCANKERNELS_TARGET_AVX2 __m256d set1(double v) { return _mm256_set1_pd(v); }
+        static SCANKERNELS_TARGET_AVX2 int eq_mask(__m256i a, __m256i b) { return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))); }
+        static SCANKERNELS_TARGET_AVX2 int eq_mask(__m256 a, __m256 b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+        static SCANKERNELS_TARGET_AVX2 int eq_mask(__m256d a, __m256d b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+        static SCANKERNELS_TARGET_AVX2 __m256i min(__m256i a, __m256i b) { return _mm256_min_epi32(a, b); }
+        static SCANKERNELS_TARGET_AVX2 __m256 min(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+        static SCANKERNELS_TARGET_AVX2 __m256d min(__m256d a, __m256d b) { return _mm256_min_pd(a, b); }
+        static SCANKERNELS_TARGET_AVX2 __m256i max(__m256i a, __m256i b) { return _mm256_max_epi32(a, b); }
+        static SCANKERNELS_TARGET_AVX2 __m256 max(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+        static SCANKERNELS_TARGET_AVX2 __m256d max(__m256d a, __m256d b) { return _mm256_max_pd(a, b); }
+        static SCANKERNELS_TARGET_AVX2 __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+        static SCANKERNELS_TARGET_AVX2 __m256d add(__m256d a, __m256d b) { return _mm256_add_pd(a, b); }
+};
+
+#endif      // SCANKERNELS_X86
+
+// Scan operations over a contiguous array of arithmetic values. int32_t, float and double
+// use SSE4.1 or AVX2 kernels when the CPU supports them; every other type, CPU and compiler
+// uses ScalarKernels. level defaults to the detected level and can be lowered to compare
+// the kernels, but must not be raised above what the CPU supports.
+//
+// Floating point sums are accumulated in several lanes, so they can differ from a sequential
+// sum by rounding. min_element and max_element are unspecified if the data contains NaN.
+template<typename T>
+struct ScanKernels
+{
+    using sum_type = scan_sum_t<T>;
+
+    // Position of the first element equal to value, or count if there is none.
+    static size_t find(const T* data, size_t count, T value, SimdLevel level = detected_simd_level()) noexcept
+    {
+#if defined(SCANKERNELS_X86)
+        if constexpr (is_simd_scannable<T>::value)
+        {
+            if (level == SimdLevel::avx2) return Avx2Kernels::find(data, count, value);
+            if (level == SimdLevel::sse41) return Sse41Kernels::find(data, count, value);
+        }
+#endif
+        (void)level;
+        return ScalarKernels<T>::find(data, count, value);
+    }
+
+    static size_t count(const T* data, size_t count, T value, SimdLevel level = detected_simd_level()) noexcept
+    {
+#if defined(SCANKERNELS_X86)
+        if constexpr (is_simd_scannable<T>::value)
+        {
+            if (level == SimdLevel::avx2) return Avx2Kernels::count(data, count, value);
+            if (level == SimdLevel::sse41) return Sse41Kernels::count(data, count, value);
+        }
+#endif
+        (void)level;
+        return ScalarKernels<T>::count(data, count, value);
+    }
+
+    // Position of the first smallest element, or count if count is 0.
+    static size_t min_element(const T* data, size_t count, SimdLevel level = detected_simd_level()) noexcept
+    {
+        return extreme_element<false>(data, count, level);
+    }
+
+    // Position of the first largest element, or count if count is 0.
+    static size_t max_element(const T* data, size_t count, SimdLevel level = detected_simd_level()) noexcept
+    {
+        return extreme_element<true>(data, count, level);
+    }
+
+    static sum_type sum(const T* data, size_t count, SimdLevel level = detected_simd_level()) noexcept
+    {
+#if defined(SCANKERNELS_X86)
+        if constexpr (is_simd_scannable<T>::value)
+        {
+            if (level == SimdLevel::avx2) return Avx2Kernels::sum(data, count);
+            if (level == SimdLevel::sse41) return Sse41Kernels::sum(data, count);
+        }
+#endif
+        (void)level;
+        return ScalarKernels<T>::sum(data, count);
+    }
+
+    // Copies the elements that satisfy pred to out, which must have room for count elements,
+    // and returns how many were copied. pred is arbitrary code, so this kernel is scalar.
+    template<typename Predicate>
+    static size_t filter(const T* data, size_t count, T* out, Predicate pred)
+    {
+        return ScalarKernels<T>::filter(data, count, out, pred);
+    }
+
+    private:
+        template<bool Max>
+        static size_t extreme_element(const T* data, size_t count, SimdLevel level) noexcept
+        {
+            if (count == 0) return 0;
+#if defined(SCANKERNELS_X86)
+            if constexpr (is_simd_scannable<T>::value)
+            {
+                if (level == SimdLevel::avx2)
+                {
+                    return Avx2Kernels::find(data, count, Avx2Kernels::extreme<Max>(data, count));
+                }
+                if (level == SimdLevel::sse41)
+                {
+                    return Sse41Kernels::find(data, count, Sse41Kernels::extreme<Max>(data, count));
+                }
+            }
+#endif
+            (void)level;
+            return ScalarKernels<T>::template extreme_element<Max>(data, count);
+        }
+};
+
+#endif      // SCANKERNELS_H
@@ -0,0 +1,220 @@
+#include "values.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+using Ints = Values<Value<int32_t>>;
+
+static std::vector<SimdLevel> supportedLevels()
+{
+    std::vector<SimdLevel> levels { SimdLevel::scalar };
+    if (detected_simd_level() >= SimdLevel::sse41) levels.push_back(SimdLevel::sse41);
+    if (detected_simd_level() >= SimdLevel::avx2) levels.push_back(SimdLevel::avx2);
+    return levels;
+}
+
+TEST(ArithmeticValuesTests, testPayloadsAreContiguous)
+{
+    Ints values;
+    ASSERT_EQ(values.cbegin(), values.cend());
+    ASSERT_EQ(values.crbegin(), values.crend());
+    for (int32_t i = 0; i < 10; ++i)
+    {
+        values.push_back(Value<int32_t>(i));
+    }
+
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(values.data()) % 32);
+    ASSERT_EQ(10, values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        ASSERT_EQ(static_cast<int32_t>(i), values.payloads()[i]);
+    }
+}
+
+TEST(ArithmeticValuesTests, testGetValues)
+{
+    Ints values;
+    values.push_back(Value<int32_t>(3));
+    values.push_back(Value<int32_t>(4));
+
+    std::vector<Value<int32_t>> copy = values.get_values();
+    ASSERT_EQ(2, copy.size());
+    ASSERT_EQ(3, copy[0].getValue());
+    ASSERT_EQ(4, copy[1].getValue());
+}
+
+TEST(ArithmeticValuesTests, testBoolIsNotSpecialized)
+{
+    // std::vector<bool> is bit-packed, so Value<bool> keeps the general layout.
+    Values<Value<bool>> values;
+    values.push_back(Value<bool>(true));
+    values.push_back(Value<bool>(false));
+    values.push_back(Value<bool>(true));
+
+    std::stringstream ss;
+    for (auto& v: values)
+    {
+        ss << v.getValue() << ' ';
+    }
+    ASSERT_EQ("1 0 1 ", ss.str());
+    ASSERT_EQ(values.cend(), values.cbegin() + 3);
+    const std::vector<Value<bool>>& all = values.get_values();
+    ASSERT_EQ(3, all.size());
+}
+
+TEST(ArithmeticValuesTests, testIterators)
+{
+    Ints values;
+    values.push_back(Value<int32_t>(1));
+    values.push_back(Value<int32_t>(2));
+    values.push_front(Value<int32_t>(0));
+
+    auto iter = values.begin();
+    ASSERT_EQ(0, iter->getValue());
+    ++iter;
+    ASSERT_EQ(1, (*iter).getValue());
+    iter += 1;
+    ASSERT_EQ(2, iter->getValue());
+    ASSERT_EQ(values.end(), iter + 1);
+    ASSERT_EQ(3, values.end() - values.begin());
+
+    std::stringstream ss;
+    for (const auto& v: values)
+    {
+        ss << v.getValue() << ' ';
+    }
+    ASSERT_EQ("0 1 2 ", ss.str());
+
+    std::stringstream rss;
+    for (auto riter = values.crbegin(); riter != values.crend(); ++riter)
+    {
+        rss << riter->getValue() << ' ';
+    }
+    ASSERT_EQ("2 1 0 ", rss.str());
+    ASSERT_EQ(3, values.rend() - values.rbegin());
+
+    Ints::const_iterator citer = values.begin();
+    ASSERT_EQ(values.cbegin(), citer);
+
+    values[1] = Value<int32_t>(5);
+    ASSERT_EQ(5, values.at(1).getValue());
+    Value<int32_t> copy = values[1];
+    ASSERT_EQ(5, copy.getValue());
+    ASSERT_THROW(values.at(3), std::out_of_range);
+}
+
+TEST(ArithmeticValuesTests, testAlgorithms)
+{
+    Ints values;
+    for (int32_t i: { 4, 1, 3, 2 })
+    {
+        values.push_back(Value<int32_t>(i));
+    }
+
+    std::sort(values.begin(), values.end(),
+        [](const Value<int32_t>& a, const Value<int32_t>& b) { return a.getValue() < b.getValue(); });
+    ASSERT_EQ(1, values[0].getValue());
+    ASSERT_EQ(4, values[3].getValue());
+
+    std::reverse(values.begin(), values.end());
+    ASSERT_EQ(4, values[0].getValue());
+    ASSERT_EQ(1, values[3].getValue());
+
+    Ints values2;
+    for (int i = 0; i < 4; ++i)
+    {
+        values2.push_back(Value<int32_t>(0));
+    }
+    std::copy(values.cbegin(), values.cend(), values2.rbegin());
+    ASSERT_EQ(1, values2[0].getValue());
+    ASSERT_EQ(4, values2[3].getValue());
+
+    std::fill(values2.begin(), values2.end(), Value<int32_t>(7));
+    ASSERT_EQ(4, values2.count(7));
+
+    auto iter = values.insert(values.cbegin() + 1, Value<int32_t>(9));
+    ASSERT_EQ(9, iter->getValue());
+    ASSERT_EQ(5, values.size());
+    ASSERT_EQ(3, values[2].getValue());
+}
+
+TEST(ArithmeticValuesTests, testScans)
+{
+    Ints values;
+    ASSERT_EQ(values.cend(), values.find(1));
+    ASSERT_EQ(values.cend(), values.min_element());
+    ASSERT_EQ(values.cend(), values.max_element());
+    ASSERT_EQ(0, values.sum());
+
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        values.push_back(Value<int32_t>((i * 37) % 50 - 20));
+    }
+    ASSERT_EQ(values.cbegin() + 3, values.find((3 * 37) % 50 - 20));
+    ASSERT_EQ(values.cend(), values.find(1000));
+    ASSERT_EQ(2, values.count(-20));
+    ASSERT_EQ(-20, values.min_element()->getValue());
+    ASSERT_EQ(values.cbegin(), values.min_element());
+    ASSERT_EQ(29, values.max_element()->getValue());
+    ASSERT_EQ(2 * (29 * 30 / 2 - 20 * 21 / 2), values.sum());
+
+    auto positives = values.filter([](int32_t value) { return value > 0; });
+    ASSERT_EQ(58, positives.size());
+    ASSERT_TRUE(std::all_of(positives.cbegin(), positives.cend(),
+        [](const Value<int32_t>& v) { return v.getValue() > 0; }));
+}
+
+TEST(ArithmeticValuesTests, testIntegerSumDoesNotOverflow)
+{
+    Ints values;
+    for (int i = 0; i < 20; ++i)
+    {
+        values.push_back(Value<int32_t>(std::numeric_limits<int32_t>::max()));
+    }
+    ASSERT_EQ(20 * int64_t(std::numeric_limits<int32_t>::max()), values.sum());
+}
+
+template<typename T>
+static void checkKernels(const std::vector<T>& data)
+{
+    for (size_t count = 0; count <= data.size(); ++count)
+    {
+        const T* begin = data.data();
+        const T* end = begin + count;
+        for (auto level: supportedLevels())
+        {
+            for (T needle: { T(0), T(3), T(7), T(-5) })
+            {
+                ASSERT_EQ(size_t(std::find(begin, end, needle) - begin),
+                    ScanKernels<T>::find(begin, count, needle, level));
+                ASSERT_EQ(size_t(std::count(begin, end, needle)),
+                    ScanKernels<T>::count(begin, count, needle, level));
+            }
+            ASSERT_EQ(size_t(std::min_element(begin, end) - begin),
+                ScanKernels<T>::min_element(begin, count, level));
+            ASSERT_EQ(size_t(std::max_element(begin, end) - begin),
+                ScanKernels<T>::max_element(begin, count, level));
+            ASSERT_EQ(std::accumulate(begin, end, typename ScanKernels<T>::sum_type(0)),
+                ScanKernels<T>::sum(begin, count, level));
+        }
+    }
+}
+
+TEST(ArithmeticValuesTests, testKernelsMatchStandardAlgorithms)
+{
+    // Small integers keep floating point sums exact whatever order they are added in.
+    std::vector<int32_t> ints;
+    for (int i = 0; i < 70; ++i)
+    {
+        ints.push_back((i * 13) % 17 - 5);
+    }
+    checkKernels(ints);
+    checkKernels(std::vector<float>(ints.begin(), ints.end()));
+    checkKernels(std::vector<double>(ints.begin(), ints.end()));
+    checkKernels(std::vector<int16_t>(ints.begin(), ints.end()));
+    checkKernels(std::vector<int64_t>(ints.begin(), ints.end()));
+}
@@ -0,0 +1,160 @@
+#include "eytzinger.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class Num : public Value<int>
+{
+    public:
+        Num(int num) : Value(num) {}
+        virtual ~Num() {}
+};
+
+class Nums : public Values<Num>
+{
+    public:
+        using value_type = Num;
+        Nums() {}
+        virtual ~Nums() {}
+};
+
+class Str : public Value<std::string>
+{
+    public:
+        Str(const std::string& str) : Value(str) {}
+        virtual ~Str() {}
+};
+
+class Strs : public Values<Str>
+{
+    public:
+        using value_type = Str;
+        Strs() {}
+        virtual ~Strs() {}
+};
+
+static auto numLess = [](const Num& num, int key) { return num.getValue() < key; };
+static auto numGreater = [](int key, const Num& num) { return key < num.getValue(); };
+
+TEST(EytzingerTests, testEmpty)
+{
+    Nums nums;
+    EytzingerIndex<Num> index(nums);
+
+    ASSERT_EQ(0, index.size());
+    ASSERT_EQ(nums.cend(), index.lower_bound(5));
+    ASSERT_EQ(nums.cend(), index.upper_bound(5));
+}
+
+TEST(EytzingerTests, testLowerUpperBound)
+{
+    // Every size up to two full trees plus one, so that complete and partial last levels are covered.
+    for (int count = 1; count <= 33; ++count)
+    {
+        Nums nums;
+        for (int i = 0; i < count; ++i)
+        {
+            nums.push_back(Num(2 * (i / 2)));   // 0 0 2 2 4 4 ...
+        }
+        EytzingerIndex<Num> index(nums);
+        ASSERT_EQ(count, index.size());
+
+        for (int key = -1; key <= count + 1; ++key)
+        {
+            ASSERT_EQ(std::lower_bound(nums.cbegin(), nums.cend(), key, numLess), index.lower_bound(key))
+                << "count " << count << ", key " << key;
+            ASSERT_EQ(std::upper_bound(nums.cbegin(), nums.cend(), key, numGreater), index.upper_bound(key))
+                << "count " << count << ", key " << key;
+        }
+    }
+}
+
+TEST(EytzingerTests, testEqualRange)
+{
+    Strs strs;
+    strs.push_back(Str("apple"));
+    strs.push_back(Str("banana"));
+    strs.push_back(Str("banana"));
+    strs.push_back(Str("cherry"));
+    EytzingerIndex<Str> index(strs);
+
+    auto range = index.equal_range("banana");
+    ASSERT_EQ(2, range.second - range.first);
+    ASSERT_EQ("banana", range.first->getValue());
+    ASSERT_EQ("cherry", range.second->getValue());
+
+    range = index.equal_range("blueberry");
+    ASSERT_EQ(range.first, range.second);
+    ASSERT_EQ("cherry", range.first->getValue());
+
+    ASSERT_EQ(strs.cbegin(), index.lower_bound("a"));
+    ASSERT_EQ(strs.cend(), index.lower_bound("date"));
+}
+
+TEST(EytzingerTests, testBatchedLowerBound)
+{
+    for (int count: { 0, 1, 7, 8, 100 })
+    {
+        Nums nums;
+        for (int i = 0; i < count; ++i)
+        {
+            nums.push_back(Num(3 * i));
+        }
+        EytzingerIndex<Num> index(nums);
+
+        std::vector<int> keys;
+        for (int key = 3 * count + 2; key >= -2; --key)
+        {
+            keys.push_back(key);
+        }
+        std::vector<Nums::const_iterator> results;
+        index.lower_bound(keys.begin(), keys.end(), std::back_inserter(results));
+
+        ASSERT_EQ(keys.size(), results.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            ASSERT_EQ(index.lower_bound(keys[i]), results[i]) << "count " << count << ", key " << keys[i];
+        }
+    }
+}
+
+TEST(EytzingerTests, testBatchedLowerBoundInputIterators)
+{
+    Values<Value<int64_t>> nums;
+    for (int64_t i = 0; i < 40; ++i)
+    {
+        nums.push_back(Value<int64_t>(2 * i));
+    }
+    EytzingerIndex<Value<int64_t>> index(nums);
+
+    // Keys of another type, read through single-pass iterators that return by value.
+    std::istringstream keys("5 0 79 80 -3 6 5 33 12 1 2 3 4 5 6 7 8 9 10 11 12 13");
+    std::vector<Values<Value<int64_t>>::const_iterator> results;
+    index.lower_bound(std::istream_iterator<int>(keys), std::istream_iterator<int>(),
+        std::back_inserter(results));
+
+    const std::vector<int> expected { 5, 0, 79, 80, -3, 6, 5, 33, 12, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13 };
+    ASSERT_EQ(expected.size(), results.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        ASSERT_EQ(index.lower_bound(expected[i]), results[i]) << "key " << expected[i];
+    }
+}
+
+TEST(EytzingerTests, testCustomKeyAndCompare)
+{
+    Strs strs;
+    strs.push_back(Str("ccc"));
+    strs.push_back(Str("bb"));
+    strs.push_back(Str("a"));
+    auto length = [](const Str& str) { return str.getValue().size(); };
+    EytzingerIndex<Str, decltype(length), std::greater<size_t>> index(strs, length);
+
+    ASSERT_EQ("bb", index.lower_bound(2)->getValue());
+    ASSERT_EQ("a", index.upper_bound(2)->getValue());
+    ASSERT_EQ(strs.cend(), index.lower_bound(0));
+}
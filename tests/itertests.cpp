@@ -413,4 +413,67 @@ TEST(IterTests, testInserter)
     ASSERT_EQ("2", values1[1].getValue());
     ASSERT_EQ("0", values1[2].getValue());
     ASSERT_EQ("1", values1[3].getValue());
-}
\ No newline at end of file
+}
+
+TEST(IterTests, testForEachPrefetchedNoVal)
+{
+    Vals values;
+    int calls = 0;
+    values.for_each_prefetched([&calls](const Val&){ ++calls; });
+
+    ASSERT_EQ(0, calls);
+}
+
+TEST(IterTests, testForEachPrefetched)
+{
+    Vals values;
+    for (int i = 0; i < 20; ++i)
+    {
+        values.push_back(Val(std::string("string ") + std::to_string(i)));
+    }
+
+    std::stringstream ss;
+    values.for_each_prefetched([&ss](const Val& v){ ss << v.getValue() << ' '; });
+    std::stringstream expected;
+    for (auto& v: values)
+    {
+        expected << v.getValue() << ' ';
+    }
+    ASSERT_EQ(expected.str(), ss.str());
+
+    for (size_t distance: { size_t(0), size_t(1), size_t(3), size_t(50) })
+    {
+        std::stringstream ss2;
+        values.for_each_prefetched([&ss2](const Val& v){ ss2 << v.getValue() << ' '; }, distance,
+            [](const Val& v){ return v.getValue().data(); });
+        ASSERT_EQ(expected.str(), ss2.str());
+    }
+}
+
+TEST(IterTests, testIteratorArithmetic)
+{
+    Vals values;
+    values.push_back(Val(std::string("string 1")));
+    values.push_back(Val(std::string("string 2")));
+    values.push_back(Val(std::string("string 3")));
+
+    auto iter = values.begin() + 2;
+    ASSERT_EQ("string 3", iter->getValue());
+    iter -= 2;
+    ASSERT_EQ("string 1", iter->getValue());
+    iter += 1;
+    ASSERT_EQ("string 2", iter->getValue());
+    ASSERT_EQ(values.begin(), values.end() - 3);
+
+    auto citer = values.cbegin() + 2;
+    ASSERT_EQ("string 3", citer->getValue());
+    citer -= 1;
+    ASSERT_EQ("string 2", citer->getValue());
+    citer += 1;
+    ASSERT_EQ(values.cend(), citer + 1);
+    ASSERT_EQ(values.cbegin(), values.cend() - 3);
+
+    auto found = std::lower_bound(values.cbegin(), values.cend(), std::string("string 2"),
+        [](const Val& v, const std::string& s){ return v.getValue() < s; });
+    ASSERT_EQ("string 2", found->getValue());
+}
@@ -0,0 +1,281 @@
+#include "valuesio.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+class Val : public Value<std::string>
+{
+    public:
+        Val(const std::string& str) : Value(str) {}
+        virtual ~Val() {}
+};
+
+class Vals : public Values<Val>
+{
+    public:
+        using value_type = Val;
+        Vals() {}
+        virtual ~Vals() {}
+};
+
+class Num : public Value<int64_t>
+{
+    public:
+        Num(int64_t num) : Value(num) {}
+        virtual ~Num() {}
+};
+
+class Nums : public Values<Num>
+{
+    public:
+        using value_type = Num;
+        Nums() {}
+        virtual ~Nums() {}
+};
+
+using Ints = Values<Value<int32_t>>;
+
+TEST(ValuesIOTests, testStringRoundTrip)
+{
+    Vals values;
+    values.push_back(Val(std::string("string 1")));
+    values.push_back(Val(std::string()));
+    values.push_back(Val(std::string(1000, 'x')));
+    values.push_back(Val(std::string("with\0nul", 8)));
+
+    for (bool checksums: { false, true })
+    {
+        std::stringstream ss;
+        write_values(ss, values, checksums);
+        Vals values2;
+        read_values(ss, values2);
+
+        ASSERT_EQ(values.size(), values2.size());
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            ASSERT_EQ(values[i].getValue(), values2[i].getValue());
+        }
+    }
+}
+
+TEST(ValuesIOTests, testRawRoundTrip)
+{
+    Nums nums;
+    Ints ints;
+    for (int i = 0; i < 1000; ++i)
+    {
+        nums.push_back(Num(int64_t(i) * 1000000007));
+        ints.push_back(Value<int32_t>(i - 500));
+    }
+
+    std::stringstream ss;
+    write_values(ss, nums);
+    Nums nums2;
+    read_values(ss, nums2);
+    ASSERT_EQ(nums.size(), nums2.size());
+    for (size_t i = 0; i < nums.size(); ++i)
+    {
+        ASSERT_EQ(nums[i].getValue(), nums2[i].getValue());
+    }
+
+    // Small blocks, and a partial block pushed before the bulk write.
+    std::stringstream ss2;
+    ValuesWriter<Value<int32_t>> writer(ss2, ints.size() + 3, true, 64);
+    for (int32_t i: { 7, 8, 9 })
+    {
+        writer.push(Value<int32_t>(i));
+    }
+    writer.write(ints);
+    writer.finish();
+
+    ValuesReader<Value<int32_t>> reader(ss2);
+    ASSERT_EQ(ints.size() + 3, reader.size());
+    Ints ints2;
+    size_t blocks = 0;
+    while (reader.read_block(ints2) != 0)
+    {
+        ++blocks;
+    }
+    ASSERT_LT(1, blocks);
+    ASSERT_EQ(ints.size() + 3, ints2.size());
+    ASSERT_EQ(7, ints2[0].getValue());
+    ASSERT_EQ(9, ints2[2].getValue());
+    for (size_t i = 0; i < ints.size(); ++i)
+    {
+        ASSERT_EQ(ints[i].getValue(), ints2[i + 3].getValue());
+    }
+}
+
+TEST(ValuesIOTests, testBoolRoundTrip)
+{
+    Values<Value<bool>> values;
+    for (int i = 0; i < 10; ++i)
+    {
+        values.push_back(Value<bool>(i % 3 == 0));
+    }
+
+    std::stringstream ss;
+    write_values(ss, values);
+    Values<Value<bool>> values2;
+    read_values(ss, values2);
+    ASSERT_EQ(values.size(), values2.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        ASSERT_EQ(values[i].getValue(), values2[i].getValue());
+    }
+}
+
+TEST(ValuesIOTests, testEmpty)
+{
+    Vals values;
+    std::stringstream ss;
+    write_values(ss, values);
+    Vals values2;
+    values2.push_back(Val(std::string("existing")));
+    read_values(ss, values2);
+
+    ASSERT_EQ(1, values2.size());
+}
+
+TEST(ValuesIOTests, testCountMismatch)
+{
+    std::stringstream ss;
+    ValuesWriter<Val> writer(ss, 2);
+    writer.push(Val(std::string("only one")));
+    ASSERT_THROW(writer.finish(), std::logic_error);
+}
+
+TEST(ValuesIOTests, testBadStreams)
+{
+    Vals values;
+    for (int i = 0; i < 10; ++i)
+    {
+        values.push_back(Val(std::string("string ") + std::to_string(i)));
+    }
+    std::stringstream ss;
+    write_values(ss, values);
+    const std::string good = ss.str();
+
+    // A failed read leaves the container as it was.
+    Vals result;
+    result.push_back(Val(std::string("existing")));
+    std::stringstream notValues("not a values stream");
+    ASSERT_THROW(read_values(notValues, result), std::runtime_error);
+    ASSERT_EQ(1, result.size());
+
+    std::stringstream wrongType(good);
+    Nums nums;
+    ASSERT_THROW(read_values(wrongType, nums), std::runtime_error);
+
+    std::stringstream truncated(good.substr(0, good.size() - 12));
+    ASSERT_THROW(read_values(truncated, result), std::runtime_error);
+    ASSERT_EQ(1, result.size());
+
+    std::string corrupt = good;
+    corrupt[40] ^= 1;
+    std::stringstream corrupted(corrupt);
+    ASSERT_THROW(read_values(corrupted, result), std::runtime_error);
+    ASSERT_EQ(1, result.size());
+
+    // The element count is the last 8 bytes of the 24-byte header.
+    std::string hugeCount = good;
+    const uint64_t count = uint64_t(1) << 40;
+    std::memcpy(&hugeCount[16], &count, sizeof(count));
+    std::stringstream hugeCounted(hugeCount);
+    ASSERT_THROW(read_values(hugeCounted, result), std::runtime_error);
+    ASSERT_EQ(1, result.size());
+
+    // The byte count of the first block follows its element count, right after the header.
+    std::string hugeBlock = good;
+    const uint32_t blockBytes = 0xffffffff;
+    std::memcpy(&hugeBlock[28], &blockBytes, sizeof(blockBytes));
+    std::stringstream hugeBlocked(hugeBlock);
+    ASSERT_THROW(read_values(hugeBlocked, result), std::runtime_error);
+    ASSERT_EQ(1, result.size());
+}
+
+TEST(ValuesIOTests, testTrailingBytesInBlock)
+{
+    Vals values;
+    values.push_back(Val(std::string("ab")));
+    std::stringstream ss;
+    write_values(ss, values, false);
+    std::string stream = ss.str();
+
+    // Grow the block by one junk byte after its only string.
+    const uint32_t blockBytes = 4 + 2 + 1;
+    std::memcpy(&stream[28], &blockBytes, sizeof(blockBytes));
+    stream.insert(24 + 8 + 4 + 2, 1, 'x');
+    std::stringstream junk(stream);
+    Vals result;
+    ASSERT_THROW(read_values(junk, result), std::runtime_error);
+    ASSERT_EQ(0, result.size());
+}
+
+TEST(ValuesIOTests, testFailedReadRemovesEarlierBlocks)
+{
+    Vals values;
+    for (int i = 0; i < 10; ++i)
+    {
+        values.push_back(Val(std::string("string ") + std::to_string(i)));
+    }
+    std::stringstream ss;
+    ValuesWriter<Val> writer(ss, values.size(), true, 16);
+    writer.write(values);
+    writer.finish();
+
+    // Every block is intact, but the end block is missing.
+    const std::string good = ss.str();
+    std::stringstream truncated(good.substr(0, good.size() - 8));
+    Vals result;
+    result.push_back(Val(std::string("existing")));
+    ASSERT_THROW(read_values(truncated, result), std::runtime_error);
+    ASSERT_EQ(1, result.size());
+    ASSERT_EQ("existing", result[0].getValue());
+}
+
+// A stream buffer that cannot seek, like a pipe or a socket.
+class NoSeekBuf : public std::stringbuf
+{
+    public:
+        explicit NoSeekBuf(const std::string& str) : std::stringbuf(str) {}
+    protected:
+        pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) override { return pos_type(-1); }
+        pos_type seekpos(pos_type, std::ios_base::openmode) override { return pos_type(-1); }
+};
+
+TEST(ValuesIOTests, testNonSeekableStream)
+{
+    Vals values;
+    for (int i = 0; i < 1000; ++i)
+    {
+        values.push_back(Val(std::string("string ") + std::to_string(i)));
+    }
+    std::stringstream ss;
+    ValuesWriter<Val> writer(ss, values.size(), true, 256);
+    writer.write(values);
+    writer.finish();
+    const std::string good = ss.str();
+
+    NoSeekBuf buf(good);
+    std::istream is(&buf);
+    ASSERT_EQ(-1, is.tellg());
+    is.clear();
+    Vals result;
+    read_values(is, result);
+    ASSERT_EQ(values.size(), result.size());
+    ASSERT_EQ("string 999", result[999].getValue());
+
+    // A huge element count in the header cannot be checked against the stream length, so
+    // only a bounded amount is reserved and the missing values are reported as an error.
+    std::string hugeCount = good;
+    const uint64_t count = uint64_t(1) << 40;
+    std::memcpy(&hugeCount[16], &count, sizeof(count));
+    NoSeekBuf hugeBuf(hugeCount);
+    std::istream hugeIs(&hugeBuf);
+    Vals hugeResult;
+    ASSERT_THROW(read_values(hugeIs, hugeResult), std::runtime_error);
+    ASSERT_EQ(0, hugeResult.size());
+}
@@ -1,8 +1,38 @@
 #ifndef VALUES_H
 #define VALUES_H
 
+#include <cstddef>
 #include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "scankernels.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+// Ask the CPU to start loading the cache line that contains addr. This is only a hint:
+// it never faults, so it is safe to call with any address, including nullptr.
+inline void prefetch_address(const void* addr) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(addr, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#else
+    (void)addr;
+#endif
+}
+
+// Default payload hook for Values::for_each_prefetched: elements have no out-of-line data.
+struct NoPayload
+{
+    template<typename T>
+    const void* operator()(const T&) const noexcept { return nullptr; }
+};
 
 template <typename T>
 class Value
@@ -15,7 +45,7 @@ class Value
         T m_value;
 };
 
-template<typename T>
+template<typename T, typename Enable = void>
 class Values
 {
     public:
@@ -45,9 +75,14 @@ class Values
             // Postfix decrement
             iterator operator--(int) { iterator tmp = *this; --m_ptr; return tmp; }
 
+            iterator& operator+=(difference_type n) { m_ptr += n; return *this; }
+            iterator& operator-=(difference_type n) { m_ptr -= n; return *this; }
+
             friend bool operator== (const iterator& a, const iterator& b) { return a.m_ptr == b.m_ptr; };
             friend bool operator!= (const iterator& a, const iterator& b) { return a.m_ptr != b.m_ptr; };
             friend size_t operator- (const iterator& a, const iterator& b) { return a.m_ptr - b.m_ptr; };
+            friend iterator operator+ (const iterator& a, difference_type n) { return iterator(a.m_ptr + n); };
+            friend iterator operator- (const iterator& a, difference_type n) { return iterator(a.m_ptr - n); };
             friend bool operator< (const iterator& a, const iterator& b) { return a.m_ptr < b.m_ptr; };
             friend const_iterator;
 
@@ -80,9 +115,14 @@ class Values
             // Postfix decrement
             const_iterator operator--(int) { const_iterator tmp = *this; --m_ptr; return tmp; }
 
+            const_iterator& operator+=(difference_type n) { m_ptr += n; return *this; }
+            const_iterator& operator-=(difference_type n) { m_ptr -= n; return *this; }
+
             friend bool operator== (const const_iterator& a, const const_iterator& b) { return a.m_ptr == b.m_ptr; };
             friend bool operator!= (const const_iterator& a, const const_iterator& b) { return a.m_ptr != b.m_ptr; };
             friend size_t operator- (const const_iterator& a, const const_iterator& b) { return a.m_ptr - b.m_ptr; };
+            friend const_iterator operator+ (const const_iterator& a, difference_type n) { return const_iterator(a.m_ptr + n); };
+            friend const_iterator operator- (const const_iterator& a, difference_type n) { return const_iterator(a.m_ptr - n); };
 
             private:
                 pointer m_ptr;
@@ -155,6 +195,9 @@ class Values
                 pointer m_ptr;
         };
 
+        // Number of elements ahead of the current one that for_each_prefetched prefetches.
+        static constexpr size_t default_prefetch_distance = 8;
+
         Values() {}
         virtual ~Values() {}
         void push_back(const T& value) { m_values.push_back(value); }
@@ -162,7 +205,10 @@ class Values
         void push_front(const T& value) { m_values.insert(m_values.cbegin(), value); }
         const std::vector<T>& get_values() const { return m_values; }
         size_t size() const { return m_values.size(); }
+        void reserve(size_t count) { m_values.reserve(count); }
         void clear() { m_values.clear(); }
+        // Removes the elements from position count onwards; does nothing if there are fewer.
+        void truncate(size_t count) { if (count < m_values.size()) m_values.erase(m_values.begin() + count, m_values.end()); }
         T& operator[](size_t pos) { return m_values[pos]; }
         const T& operator[](size_t pos) const { return m_values[pos]; }
         T& at(size_t pos)
@@ -195,6 +241,41 @@ class Values
             }
             return iter;
         }
+        // Calls f for each element, in order, like std::for_each, but issues software prefetches
+        // ahead of the scan. This helps when the elements own heap blocks (for example long
+        // std::strings) and a plain scan is bound by memory latency.
+        // payload is a hook that returns the address of an element's out-of-line data, e.g.
+        //     [](const Val& v) { return v.getValue().data(); }
+        // Reading that address requires the element itself, so the element 2 * distance positions
+        // ahead is prefetched first, and its payload is prefetched once it is distance positions
+        // ahead, by which time the element should already be in cache.
+        template<typename Function, typename Payload = NoPayload>
+        Function for_each_prefetched(Function f, size_t distance = default_prefetch_distance,
+            Payload payload = Payload()) const
+        {
+            const T* data = m_values.data();
+            const size_t count = m_values.size();
+            for (size_t pos = 0; pos < count; ++pos)
+            {
+                if (distance != 0)
+                {
+                    if (pos + 2 * distance < count)
+                    {
+                        prefetch_address(data + pos + 2 * distance);
+                    }
+                    // Without a hook there is no payload to prefetch.
+                    if constexpr (!std::is_same_v<Payload, NoPayload>)
+                    {
+                        if (pos + distance < count)
+                        {
+                            prefetch_address(payload(data[pos + distance]));
+                        }
+                    }
+                }
+                f(data[pos]);
+            }
+            return f;
+        }
         iterator begin() noexcept { return iterator(m_values.data()); }
         iterator end() noexcept { return iterator(m_values.data() + m_values.size()); }
         const_iterator cbegin() const noexcept { return const_iterator(m_values.data()); }
@@ -207,4 +288,227 @@ class Values
         std::vector<T> m_values;
 };
 
+// Allocator for storage that SIMD code reads, aligned to Alignment bytes.
+template<typename T, size_t Alignment>
+struct AlignedAllocator
+{
+    using value_type = T;
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept {}
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* ptr, size_t) noexcept { ::operator delete(ptr, std::align_val_t(Alignment)); }
+
+    friend bool operator== (const AlignedAllocator&, const AlignedAllocator&) { return true; }
+    friend bool operator!= (const AlignedAllocator&, const AlignedAllocator&) { return false; }
+};
+
+// Whether Values<Value<T>> uses the structure-of-arrays specialization below. bool is left out:
+// a std::vector<bool> is bit-packed and has no data() to hand out pointers into.
+template<typename T>
+struct has_contiguous_payloads
+    : std::integral_constant<bool, std::is_arithmetic_v<T> && !std::is_same_v<T, bool>> {};
+
+// Structure-of-arrays specialization for Value<T> with arithmetic T other than bool.
+// Stored as Value<T> objects, every number sits next to a vptr, which rules out vectorized
+// scans. This specialization keeps only the raw T payloads, in one contiguous 32-byte aligned
+// array. find, count, min_element, max_element, sum and filter run the ScanKernels over them.
+//
+// There are no Value<T> objects to refer to, so this is not fully source compatible with the
+// general Values:
+// * operator[], at() and the iterators return proxy references. They have getValue(), convert
+//   to Value<T>, and the mutable ones can be assigned a Value<T>, but they do not bind to a
+//   Value<T>&. Use auto or const auto& rather than auto& or Value<T>& to hold them, including
+//   in range-based for loops.
+// * get_values() returns a copy of the elements as a std::vector<Value<T>> rather than a
+//   reference. payloads() gives direct access to the stored numbers without copying.
+template<typename T>
+class Values<Value<T>, std::enable_if_t<has_contiguous_payloads<T>::value>>
+{
+    public:
+        using payload_vector = std::vector<T, AlignedAllocator<T, 32>>;
+        using sum_type = typename ScanKernels<T>::sum_type;
+
+        class const_reference
+        {
+            public:
+                explicit const_reference(const T* ptr) : m_ptr(ptr) {}
+                const T& getValue() const noexcept { return *m_ptr; }
+                operator Value<T>() const { return Value<T>(*m_ptr); }
+            private:
+                const T* m_ptr;
+        };
+
+        class reference
+        {
+            public:
+                explicit reference(T* ptr) : m_ptr(ptr) {}
+                reference(const reference&) = default;
+                const T& getValue() const noexcept { return *m_ptr; }
+                operator Value<T>() const { return Value<T>(*m_ptr); }
+                operator const_reference() const { return const_reference(m_ptr); }
+
+                // Assignments write through to the element, as they would for a Value<T>&.
+                reference& operator=(const Value<T>& value) { *m_ptr = value.getValue(); return *this; }
+                reference& operator=(const reference& other) { *m_ptr = *other.m_ptr; return *this; }
+                reference& operator=(const const_reference& other) { *m_ptr = other.getValue(); return *this; }
+                friend void swap(reference a, reference b) noexcept { std::swap(*a.m_ptr, *b.m_ptr); }
+            private:
+                T* m_ptr;
+        };
+
+    private:
+        // Result of operator-> on the iterators: there is no Value<T> object to point to.
+        template<typename Reference>
+        struct arrow_proxy
+        {
+            Reference ref;
+            const Reference* operator->() const { return &ref; }
+        };
+
+        // All four iterator types. Reverse iterators (Step == -1) point one past the element
+        // they refer to, like std::reverse_iterator, so rend() does not point before the array.
+        template<typename Pointer, typename Reference, std::ptrdiff_t Step>
+        struct proxy_iterator
+        {
+            using iterator_category = std::random_access_iterator_tag;
+            using difference_type   = std::ptrdiff_t;
+            using value_type        = Value<T>;
+            using pointer           = arrow_proxy<Reference>;
+            using reference         = Reference;
+
+            explicit proxy_iterator(Pointer ptr) : m_ptr(ptr) {}
+            // Mutable iterators convert to their const counterparts.
+            template<typename OtherPointer, typename OtherReference,
+                typename = std::enable_if_t<!std::is_same_v<OtherPointer, Pointer> &&
+                    std::is_convertible_v<OtherPointer, Pointer>>>
+            proxy_iterator(const proxy_iterator<OtherPointer, OtherReference, Step>& it) : m_ptr(it.m_ptr) {}
+
+            Reference operator*() const { return Reference(m_ptr + offset); }
+            pointer operator->() const { return pointer{ Reference(m_ptr + offset) }; }
+            Reference operator[](difference_type n) const { return Reference(m_ptr + n * Step + offset); }
+
+            proxy_iterator& operator++() { m_ptr += Step; return *this; }
+            proxy_iterator operator++(int) { proxy_iterator tmp = *this; m_ptr += Step; return tmp; }
+            proxy_iterator& operator--() { m_ptr -= Step; return *this; }
+            proxy_iterator operator--(int) { proxy_iterator tmp = *this; m_ptr -= Step; return tmp; }
+            proxy_iterator& operator+=(difference_type n) { m_ptr += n * Step; return *this; }
+            proxy_iterator& operator-=(difference_type n) { m_ptr -= n * Step; return *this; }
+
+            friend bool operator== (const proxy_iterator& a, const proxy_iterator& b) { return a.m_ptr == b.m_ptr; }
+            friend bool operator!= (const proxy_iterator& a, const proxy_iterator& b) { return a.m_ptr != b.m_ptr; }
+            friend bool operator< (const proxy_iterator& a, const proxy_iterator& b) { return (a.m_ptr - b.m_ptr) * Step < 0; }
+            friend difference_type operator- (const proxy_iterator& a, const proxy_iterator& b) { return (a.m_ptr - b.m_ptr) * Step; }
+            friend proxy_iterator operator+ (const proxy_iterator& a, difference_type n) { return proxy_iterator(a.m_ptr + n * Step); }
+            friend proxy_iterator operator- (const proxy_iterator& a, difference_type n) { return proxy_iterator(a.m_ptr - n * Step); }
+            template<typename, typename, std::ptrdiff_t> friend struct proxy_iterator;
+
+            private:
+                static constexpr std::ptrdiff_t offset = Step < 0 ? -1 : 0;
+                Pointer m_ptr;
+        };
+
+    public:
+        using iterator = proxy_iterator<T*, reference, 1>;
+        using const_iterator = proxy_iterator<const T*, const_reference, 1>;
+        using reverse_iterator = proxy_iterator<T*, reference, -1>;
+        using const_reverse_iterator = proxy_iterator<const T*, const_reference, -1>;
+
+        static constexpr size_t default_prefetch_distance = 8;
+
+        Values() {}
+        virtual ~Values() {}
+        void push_back(const Value<T>& value) { m_values.push_back(value.getValue()); }
+        // Depending on the underlying storage type, this method could be very inefficient.
+        void push_front(const Value<T>& value) { m_values.insert(m_values.cbegin(), value.getValue()); }
+        // The raw payloads, in element order.
+        const payload_vector& payloads() const noexcept { return m_values; }
+        // The elements as Value<T> objects. This builds a new vector on every call; prefer
+        // payloads() or the iterators.
+        std::vector<Value<T>> get_values() const { return std::vector<Value<T>>(m_values.begin(), m_values.end()); }
+        const T* data() const noexcept { return m_values.data(); }
+        // Appends count raw payloads in one copy.
+        void append_payloads(const T* payloads, size_t count) { m_values.insert(m_values.end(), payloads, payloads + count); }
+        size_t size() const { return m_values.size(); }
+        void reserve(size_t count) { m_values.reserve(count); }
+        void clear() { m_values.clear(); }
+        // Removes the elements from position count onwards; does nothing if there are fewer.
+        void truncate(size_t count) { if (count < m_values.size()) m_values.erase(m_values.begin() + count, m_values.end()); }
+        reference operator[](size_t pos) { return reference(m_values.data() + pos); }
+        const_reference operator[](size_t pos) const { return const_reference(m_values.data() + pos); }
+        reference at(size_t pos)
+        {
+            if(pos >= m_values.size()) throw std::out_of_range("Out of range");
+            return (*this)[pos];
+        }
+        const_reference at(size_t pos) const
+        {
+            if(pos >= m_values.size()) throw std::out_of_range("Out of range");
+            return (*this)[pos];
+        }
+        iterator insert(const_iterator pos, const Value<T>& val)
+        {
+            auto distance = pos - cbegin();
+            m_values.insert(m_values.cbegin() + distance, val.getValue());
+            return begin() + distance;
+        }
+        // The payloads are contiguous, so the hardware prefetcher already streams them in; the
+        // prefetch arguments are accepted for compatibility with the general Values.
+        template<typename Function, typename Payload = NoPayload>
+        Function for_each_prefetched(Function f, size_t = default_prefetch_distance,
+            Payload = Payload()) const
+        {
+            for (const T& value: m_values)
+            {
+                f(const_reference(&value));
+            }
+            return f;
+        }
+
+        // First element whose payload equals value, or cend().
+        const_iterator find(const T& value) const
+        {
+            return cbegin() + ScanKernels<T>::find(data(), size(), value);
+        }
+        size_t count(const T& value) const { return ScanKernels<T>::count(data(), size(), value); }
+        // First smallest element, or cend() if the container is empty.
+        const_iterator min_element() const
+        {
+            return cbegin() + ScanKernels<T>::min_element(data(), size());
+        }
+        // First largest element, or cend() if the container is empty.
+        const_iterator max_element() const
+        {
+            return cbegin() + ScanKernels<T>::max_element(data(), size());
+        }
+        // Sum of the payloads; integers are summed in 64 bits.
+        sum_type sum() const { return ScanKernels<T>::sum(data(), size()); }
+        // A new container with the elements whose payload satisfies pred, in order.
+        template<typename Predicate>
+        Values filter(Predicate pred) const
+        {
+            Values result;
+            result.m_values.resize(size());
+            result.m_values.resize(ScanKernels<T>::filter(data(), size(), result.m_values.data(), pred));
+            return result;
+        }
+
+        iterator begin() noexcept { return iterator(m_values.data()); }
+        iterator end() noexcept { return iterator(m_values.data() + m_values.size()); }
+        const_iterator cbegin() const noexcept { return const_iterator(m_values.data()); }
+        const_iterator cend() const noexcept { return const_iterator(m_values.data() + m_values.size()); }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(m_values.data() + m_values.size()); }
+        reverse_iterator rend() noexcept { return reverse_iterator(m_values.data()); }
+        const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(m_values.data() + m_values.size()); }
+        const_reverse_iterator crend() const noexcept { return const_reverse_iterator(m_values.data()); }
+    private:
+        payload_vector m_values;
+};
+
 #endif      // VALUES_H
\ No newline at end of file
@@ -0,0 +1,491 @@
+#ifndef VALUESIO_H
+#define VALUESIO_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "values.h"
+
+// Binary serialization of Values containers.
+//
+// A stream holds a header followed by blocks of elements and an end block:
+//     header: "VALS", uint16 version, uint8 encoding, uint8 flags, uint32 payload size,
+//             uint32 byte order mark, uint64 element count
+//     block:  uint32 element count, uint32 byte count, the bytes,
+//             and a uint64 checksum of the bytes when the checksum flag is set
+//     end:    a block header with an element count of 0 and a byte count of 0
+// Elements are stored as the payloads returned by getValue(). Trivially copyable payloads are
+// stored raw, as sizeof(payload) bytes each; std::string payloads are stored as a uint32 length
+// followed by the characters. Numbers are written in the byte order of the writing machine;
+// the byte order mark lets a reader on a machine with a different byte order reject the stream.
+
+struct ValuesFormat
+{
+    static constexpr char magic[4] = { 'V', 'A', 'L', 'S' };
+    static constexpr uint16_t version = 1;
+    static constexpr uint32_t byte_order_mark = 0x01020304;
+    static constexpr size_t default_block_bytes = size_t(1) << 20;
+    // Largest block a reader accepts, so that a corrupt block size cannot make it allocate
+    // gigabytes. Writers start a new block before exceeding it; only a single string longer
+    // than this cannot be written.
+    static constexpr size_t max_block_bytes = size_t(1) << 28;
+
+    enum Encoding : uint8_t
+    {
+        raw = 0,
+        length_prefixed_string = 1
+    };
+
+    enum Flags : uint8_t
+    {
+        checksums = 1
+    };
+
+    // Checksum of one block: FNV-1a over 8-byte words, with a shift after each multiply so
+    // that changes in the high bits of a word also reach the low bits of the result.
+    static uint64_t checksum(const char* data, size_t size) noexcept
+    {
+        const uint64_t prime = 1099511628211ull;
+        uint64_t hash = 14695981039346656037ull;
+        size_t pos = 0;
+        for (; pos + 8 <= size; pos += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + pos, 8);
+            hash = (hash ^ word) * prime;
+            hash ^= hash >> 32;
+        }
+        for (; pos < size; ++pos)
+        {
+            hash = (hash ^ static_cast<unsigned char>(data[pos])) * prime;
+        }
+        return hash;
+    }
+};
+
+// The payload type of the elements of Values<T>, and how it is encoded.
+template<typename T>
+struct ValuesPayload
+{
+    using type = std::decay_t<decltype(std::declval<const T&>().getValue())>;
+    static constexpr bool is_string = std::is_same_v<type, std::string>;
+    static constexpr bool is_raw = std::is_trivially_copyable_v<type>;
+    static_assert(is_string || is_raw,
+        "Values can only be serialized if the payload is std::string or trivially copyable");
+    static constexpr ValuesFormat::Encoding encoding =
+        is_string ? ValuesFormat::length_prefixed_string : ValuesFormat::raw;
+    // Values<Value<T>> for arithmetic T other than bool keeps its payloads in one array, which
+    // can be copied to and from the stream directly.
+    static constexpr bool is_contiguous = std::is_same_v<T, Value<type>> && has_contiguous_payloads<type>::value;
+};
+
+// Writes elements to a stream in blocks of roughly blockBytes bytes. The element count must be
+// known up front, so that readers can reserve space; finish() checks that exactly that many
+// elements were written and must be called after the last one.
+template<typename T>
+class ValuesWriter
+{
+    public:
+        using payload_type = typename ValuesPayload<T>::type;
+
+        ValuesWriter(std::ostream& os, uint64_t count, bool checksums = true,
+            size_t blockBytes = ValuesFormat::default_block_bytes)
+            : m_os(os), m_count(count), m_checksums(checksums),
+              m_blockBytes(std::min(blockBytes, ValuesFormat::max_block_bytes))
+        {
+            m_block.reserve(m_blockBytes);
+            std::vector<char> header;
+            header.insert(header.end(), ValuesFormat::magic, ValuesFormat::magic + 4);
+            put(header, ValuesFormat::version);
+            put(header, static_cast<uint8_t>(ValuesPayload<T>::encoding));
+            put(header, static_cast<uint8_t>(checksums ? ValuesFormat::checksums : 0));
+            put(header, static_cast<uint32_t>(ValuesPayload<T>::is_raw ? sizeof(payload_type) : 0));
+            put(header, ValuesFormat::byte_order_mark);
+            put(header, m_count);
+            write_bytes(header.data(), header.size());
+        }
+        ValuesWriter(const ValuesWriter&) = delete;
+        ValuesWriter& operator=(const ValuesWriter&) = delete;
+
+        void push(const T& value)
+        {
+            // Start a new block rather than let this one grow past what readers accept.
+            if (m_blockCount != 0 && m_block.size() + element_bytes(value) > ValuesFormat::max_block_bytes)
+            {
+                flush_block();
+            }
+            if constexpr (ValuesPayload<T>::is_string)
+            {
+                const std::string& str = value.getValue();
+                if (str.size() > std::numeric_limits<uint32_t>::max())
+                {
+                    throw std::length_error("String too long to serialize");
+                }
+                put(m_block, static_cast<uint32_t>(str.size()));
+                m_block.insert(m_block.end(), str.data(), str.data() + str.size());
+            }
+            else
+            {
+                put(m_block, value.getValue());
+            }
+            ++m_blockCount;
+            ++m_written;
+            if (m_block.size() >= m_blockBytes)
+            {
+                flush_block();
+            }
+        }
+
+        void write(const Values<T>& values)
+        {
+            if constexpr (ValuesPayload<T>::is_contiguous)
+            {
+                // Whole blocks go straight from the container to the stream.
+                const size_t perBlock = std::max<size_t>(1, m_blockBytes / sizeof(payload_type));
+                size_t pos = 0;
+                while (pos < values.size())
+                {
+                    if (m_blockCount != 0)
+                    {
+                        push(values[pos++]);
+                        continue;
+                    }
+                    const size_t count = std::min(perBlock, values.size() - pos);
+                    write_block(reinterpret_cast<const char*>(values.data() + pos), count,
+                        count * sizeof(payload_type));
+                    m_written += count;
+                    pos += count;
+                }
+            }
+            else
+            {
+                for (auto iter = values.cbegin(); iter != values.cend(); ++iter)
+                {
+                    push(*iter);
+                }
+            }
+        }
+
+        void finish()
+        {
+            flush_block();
+            if (m_written != m_count)
+            {
+                throw std::logic_error("Number of values written does not match the count in the header");
+            }
+            std::vector<char> end;
+            put(end, uint32_t(0));
+            put(end, uint32_t(0));
+            write_bytes(end.data(), end.size());
+            m_os.flush();
+        }
+
+    private:
+        static size_t element_bytes(const T& value)
+        {
+            if constexpr (ValuesPayload<T>::is_string)
+            {
+                return 4 + value.getValue().size();
+            }
+            else
+            {
+                return sizeof(payload_type);
+            }
+        }
+
+        template<typename U>
+        static void put(std::vector<char>& buffer, const U& value)
+        {
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(U));
+        }
+
+        void write_bytes(const char* data, size_t size)
+        {
+            m_os.write(data, static_cast<std::streamsize>(size));
+            if (!m_os)
+            {
+                throw std::runtime_error("Error writing values");
+            }
+        }
+
+        void write_block(const char* data, size_t count, size_t size)
+        {
+            if (size > ValuesFormat::max_block_bytes)
+            {
+                throw std::length_error("Value too large to serialize");
+            }
+            char header[8];
+            const uint32_t count32 = static_cast<uint32_t>(count);
+            const uint32_t size32 = static_cast<uint32_t>(size);
+            std::memcpy(header, &count32, 4);
+            std::memcpy(header + 4, &size32, 4);
+            write_bytes(header, sizeof(header));
+            write_bytes(data, size);
+            if (m_checksums)
+            {
+                const uint64_t checksum = ValuesFormat::checksum(data, size);
+                write_bytes(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+            }
+        }
+
+        void flush_block()
+        {
+            if (m_blockCount == 0) return;
+            write_block(m_block.data(), m_blockCount, m_block.size());
+            m_block.clear();
+            m_blockCount = 0;
+        }
+
+        std::ostream& m_os;
+        uint64_t m_count;
+        bool m_checksums;
+        size_t m_blockBytes;
+        std::vector<char> m_block;
+        size_t m_blockCount = 0;
+        uint64_t m_written = 0;
+};
+
+// Reads a stream written by ValuesWriter one block at a time. The constructor reads and
+// checks the header; errors in the stream are reported with std::runtime_error.
+template<typename T>
+class ValuesReader
+{
+    public:
+        using payload_type = typename ValuesPayload<T>::type;
+
+        explicit ValuesReader(std::istream& is) : m_is(is)
+        {
+            char magic[4];
+            read_bytes(magic, sizeof(magic));
+            if (std::memcmp(magic, ValuesFormat::magic, sizeof(magic)) != 0)
+            {
+                throw std::runtime_error("Not a values stream");
+            }
+            const auto version = get<uint16_t>();
+            if (version == 0 || version > ValuesFormat::version)
+            {
+                throw std::runtime_error("Unsupported values stream version " + std::to_string(version));
+            }
+            const auto encoding = get<uint8_t>();
+            m_checksums = (get<uint8_t>() & ValuesFormat::checksums) != 0;
+            const auto payloadSize = get<uint32_t>();
+            if (encoding != ValuesPayload<T>::encoding ||
+                payloadSize != (ValuesPayload<T>::is_raw ? sizeof(payload_type) : 0))
+            {
+                throw std::runtime_error("Values stream does not match the payload type");
+            }
+            if (get<uint32_t>() != ValuesFormat::byte_order_mark)
+            {
+                throw std::runtime_error("Values stream was written with a different byte order");
+            }
+            m_count = get<uint64_t>();
+        }
+        ValuesReader(const ValuesReader&) = delete;
+        ValuesReader& operator=(const ValuesReader&) = delete;
+
+        // Number of elements in the stream, from the header.
+        uint64_t size() const noexcept { return m_count; }
+
+        // Appends the elements of the next block to values and returns how many there were,
+        // or 0 once the end of the stream has been reached. A bad block leaves values as it was.
+        size_t read_block(Values<T>& values)
+        {
+            if (m_done) return 0;
+            const auto count = get<uint32_t>();
+            const auto size = get<uint32_t>();
+            if (count == 0)
+            {
+                if (size != 0 || m_read != m_count)
+                {
+                    throw std::runtime_error("Values stream is truncated or corrupt");
+                }
+                m_done = true;
+                return 0;
+            }
+            if (m_read + count > m_count)
+            {
+                throw std::runtime_error("Values stream holds more values than its header says");
+            }
+            if (size > ValuesFormat::max_block_bytes)
+            {
+                throw std::runtime_error("Values stream is corrupt");
+            }
+            // Raw payloads are read straight into a buffer of the payload type, which is
+            // properly aligned for them; strings are parsed out of a byte buffer.
+            char* body;
+            if constexpr (ValuesPayload<T>::is_string)
+            {
+                m_block.resize(size);
+                body = m_block.data();
+            }
+            else
+            {
+                if (size != count * sizeof(payload_type))
+                {
+                    throw std::runtime_error("Values stream is corrupt");
+                }
+                m_payloads.resize(count);
+                body = reinterpret_cast<char*>(m_payloads.data());
+            }
+            read_bytes(body, size);
+            if (m_checksums && get<uint64_t>() != ValuesFormat::checksum(body, size))
+            {
+                throw std::runtime_error("Values stream checksum mismatch");
+            }
+            const size_t original = values.size();
+            try
+            {
+                decode(values, count);
+            }
+            catch (...)
+            {
+                values.truncate(original);
+                throw;
+            }
+            m_read += count;
+            return count;
+        }
+
+        // Reserves space for and appends all remaining elements. The count in the header is not
+        // trusted further than the rest of the stream could hold; beyond that the container
+        // grows as the blocks arrive. If the stream turns out to be bad, values is truncated
+        // back to its size on entry before the exception propagates.
+        void read(Values<T>& values)
+        {
+            const size_t original = values.size();
+            try
+            {
+                values.reserve(original + static_cast<size_t>(std::min(m_count - m_read, max_remaining())));
+                while (read_block(values) != 0)
+                {
+                }
+            }
+            catch (...)
+            {
+                values.truncate(original);
+                throw;
+            }
+        }
+
+    private:
+        // Raw bools are read as bytes, as std::vector<bool> is bit-packed.
+        using block_element = std::conditional_t<std::is_same_v<payload_type, bool>, unsigned char, payload_type>;
+        static_assert(sizeof(block_element) == sizeof(payload_type), "bool must be one byte");
+        // Smallest number of bytes an element takes up in a block.
+        static constexpr size_t min_element_bytes = ValuesPayload<T>::is_string ? 4 : sizeof(payload_type);
+
+        // Upper bound on the number of elements to reserve space for: what the remaining length
+        // of a seekable stream could hold, or, for a stream that cannot seek and so cannot be
+        // checked, default_block_bytes worth of elements.
+        uint64_t max_remaining()
+        {
+            const auto here = m_is.tellg();
+            if (here != std::istream::pos_type(-1))
+            {
+                m_is.seekg(0, std::ios::end);
+                const auto end = m_is.tellg();
+                m_is.clear();
+                m_is.seekg(here);
+                if (end != std::istream::pos_type(-1))
+                {
+                    const uint64_t bound = static_cast<uint64_t>(end - here) / min_element_bytes;
+                    if (m_count - m_read > bound)
+                    {
+                        throw std::runtime_error("Values stream is truncated");
+                    }
+                    return bound;
+                }
+            }
+            m_is.clear();
+            return ValuesFormat::default_block_bytes / sizeof(T);
+        }
+
+        template<typename U>
+        U get()
+        {
+            U value;
+            read_bytes(reinterpret_cast<char*>(&value), sizeof(U));
+            return value;
+        }
+
+        void read_bytes(char* data, size_t size)
+        {
+            m_is.read(data, static_cast<std::streamsize>(size));
+            if (static_cast<size_t>(m_is.gcount()) != size)
+            {
+                throw std::runtime_error("Values stream is truncated");
+            }
+        }
+
+        void decode(Values<T>& values, size_t count)
+        {
+            if constexpr (ValuesPayload<T>::is_string)
+            {
+                const char* pos = m_block.data();
+                const char* end = pos + m_block.size();
+                std::string str;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    uint32_t length;
+                    if (end - pos < 4) throw std::runtime_error("Values stream is corrupt");
+                    std::memcpy(&length, pos, 4);
+                    pos += 4;
+                    if (static_cast<size_t>(end - pos) < length) throw std::runtime_error("Values stream is corrupt");
+                    str.assign(pos, length);
+                    pos += length;
+                    values.push_back(T(str));
+                }
+                if (pos != end)
+                {
+                    throw std::runtime_error("Values stream is corrupt");
+                }
+            }
+            else if constexpr (ValuesPayload<T>::is_contiguous)
+            {
+                values.append_payloads(m_payloads.data(), count);
+            }
+            else
+            {
+                for (const auto& payload: m_payloads)
+                {
+                    values.push_back(T(static_cast<payload_type>(payload)));
+                }
+            }
+        }
+
+        std::istream& m_is;
+        uint64_t m_count = 0;
+        uint64_t m_read = 0;
+        bool m_checksums = false;
+        bool m_done = false;
+        std::vector<char> m_block;
+        std::vector<block_element> m_payloads;
+};
+
+// Writes all of values to os as a complete values stream.
+template<typename T>
+void write_values(std::ostream& os, const Values<T>& values, bool checksums = true)
+{
+    ValuesWriter<T> writer(os, values.size(), checksums);
+    writer.write(values);
+    writer.finish();
+}
+
+// Appends all values from a complete values stream in is to values.
+template<typename T>
+void read_values(std::istream& is, Values<T>& values)
+{
+    ValuesReader<T> reader(is);
+    reader.read(values);
+}
+
+#endif      // VALUESIO_H